@@ -0,0 +1,329 @@
+#ifndef BASELINES_H
+#define BASELINES_H
+#include <atomic>
+#include <cassert>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+#include "lf_vec.h"
+
+// competitor vectors for the benchmark
+// all of them have the same interface as lockfree::Vector's non LEAK ops so main.cpp can plug them in:
+//   Vec(size_t initial_size, size_t capacity)
+//   read_at / write_at / push_back / pop_back
+//
+// every backend starts with initial_size default elements (so random accesses have somewhere to land)
+// and reserves capacity up front so no backend pays for reallocation while the lock free one doesn't
+// out of range reads/writes are ignored (reads return T()) since replayed traces can point anywhere
+namespace baseline {
+// test and test and set spinlock
+// spins on a plain load so waiting threads don't keep stealing the cache line, then yields
+// so oversubscribed runs (more threads than cores) don't just burn their time slice
+class SpinLock {
+private:
+    std::atomic<bool> locked{false};
+public:
+    void lock(){
+        while(true){
+            if(!locked.exchange(true, std::memory_order_acquire)){
+                return;
+            }
+
+            int spins = 0;
+            while(locked.load(std::memory_order_relaxed)){
+                if(++spins == 64){
+                    spins = 0;
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    void unlock(){
+        locked.store(false, std::memory_order_release);
+    }
+};
+
+// std::vector behind a single lock (std::mutex is the original STL-MTX baseline)
+template <typename T, typename Lock>
+class LockedVector {
+private:
+    Lock lock;
+    std::vector<T> vec;
+public:
+    LockedVector(size_t initial_size, size_t capacity){
+        vec.reserve(capacity);
+        vec.resize(initial_size);
+    }
+
+    T read_at(size_t idx){
+        std::lock_guard<Lock> guard(lock);
+        return idx < vec.size() ? vec[idx] : T();
+    }
+
+    void write_at(size_t idx, T val){
+        std::lock_guard<Lock> guard(lock);
+        if(idx < vec.size())
+            vec[idx] = val;
+    }
+
+    void push_back(T elem){
+        std::lock_guard<Lock> guard(lock);
+        vec.push_back(elem);
+    }
+
+    T pop_back(){
+        std::lock_guard<Lock> guard(lock);
+        if(vec.empty())
+            return T();
+        T res = vec.back();
+        vec.pop_back();
+        return res;
+    }
+};
+
+// std::vector behind a std::shared_mutex, reads share the lock and everything else is exclusive
+template <typename T>
+class SharedMutexVector {
+private:
+    std::shared_mutex lock;
+    std::vector<T> vec;
+public:
+    SharedMutexVector(size_t initial_size, size_t capacity){
+        vec.reserve(capacity);
+        vec.resize(initial_size);
+    }
+
+    T read_at(size_t idx){
+        std::shared_lock<std::shared_mutex> guard(lock);
+        return idx < vec.size() ? vec[idx] : T();
+    }
+
+    void write_at(size_t idx, T val){
+        std::unique_lock<std::shared_mutex> guard(lock);
+        if(idx < vec.size())
+            vec[idx] = val;
+    }
+
+    void push_back(T elem){
+        std::unique_lock<std::shared_mutex> guard(lock);
+        vec.push_back(elem);
+    }
+
+    T pop_back(){
+        std::unique_lock<std::shared_mutex> guard(lock);
+        if(vec.empty())
+            return T();
+        T res = vec.back();
+        vec.pop_back();
+        return res;
+    }
+};
+
+// fixed capacity array where each slot is guarded by one of STRIPES locks (idx % STRIPES)
+// random accesses only take their stripe, push/pop take the size lock then the stripe of the tail
+// (always in that order so they can't deadlock)
+template <typename T>
+class StripedVector {
+private:
+    static constexpr int STRIPES = 64;
+
+    // padded so neighbouring stripes don't share a cache line
+    struct alignas(64) Stripe {
+        std::mutex lock;
+    };
+
+    Stripe stripes[STRIPES];
+    std::mutex size_lock;
+    size_t size;
+    size_t capacity;
+    T* data;
+
+    std::mutex& stripe(size_t idx){
+        return stripes[idx % STRIPES].lock;
+    }
+public:
+    StripedVector(size_t initial_size, size_t capacity)
+    : size(initial_size), capacity(capacity), data(new T[capacity]()){
+        assert(initial_size <= capacity);
+    }
+
+    ~StripedVector(){
+        delete[] data;
+    }
+
+    // only checks against capacity, the slot is always valid memory and the size lock would serialize us
+    T read_at(size_t idx){
+        if(idx >= capacity)
+            return T();
+        std::lock_guard<std::mutex> guard(stripe(idx));
+        return data[idx];
+    }
+
+    void write_at(size_t idx, T val){
+        if(idx >= capacity)
+            return;
+        std::lock_guard<std::mutex> guard(stripe(idx));
+        data[idx] = val;
+    }
+
+    void push_back(T elem){
+        std::lock_guard<std::mutex> size_guard(size_lock);
+        assert(size < capacity); // fixed capacity, the benchmark sizes it so this never happens
+        std::lock_guard<std::mutex> guard(stripe(size));
+        data[size++] = elem;
+    }
+
+    T pop_back(){
+        std::lock_guard<std::mutex> size_guard(size_lock);
+        if(size == 0)
+            return T();
+        size--;
+        std::lock_guard<std::mutex> guard(stripe(size));
+        return data[size];
+    }
+};
+
+// tbb::concurrent_vector style segmented vector
+// segment k holds indices [2^k, 2^(k+1)) (segment 0 holds [0, 2)) and segments are never moved
+// push_back claims its index with a single fetch_add and then allocs the segment if it is the first one in
+//
+// like tbb there is no real pop, we give it a CAS on the size so the op mix still works
+// that alone can lose elements, a pop can claim an index whose push took it but hasn't stored yet
+// so every slot also has a state and the two hand the slot over through it:
+//   push waits for EMPTY -> BUSY, stores, then FULL
+//   pop waits for FULL -> BUSY, loads, then EMPTY
+// pushes and pops that land on the same index alternate in size order so every pop gets a pushed value
+// (the waits make this blocking, which is fine for a baseline)
+// reads/writes don't look at the state or the size (only the preallocated capacity, like StripedVector)
+// so like tbb's operator[] they never touch the contended size and can see a slot mid push
+template <typename T>
+class SegmentedVector {
+private:
+    static constexpr int SEGMENTS = 64;
+
+    enum SlotState : int {
+        EMPTY,
+        BUSY,
+        FULL
+    };
+
+    struct Slot {
+        std::atomic<T> value;
+        std::atomic<int> state;
+    };
+
+    std::atomic<Slot*> segments[SEGMENTS];
+    size_t capacity;
+
+    // every push/pop RMWs this so it gets its own cache line
+    alignas(64) std::atomic<size_t> size;
+
+    static int segment_of(size_t idx){
+        return highest_bit(idx | 1);
+    }
+
+    static size_t segment_base(int segment){
+        return ((size_t)1 << segment) & ~(size_t)1;
+    }
+
+    static size_t segment_size(int segment){
+        return segment == 0 ? 2 : (size_t)1 << segment;
+    }
+
+    Slot* segment(int segment){
+        Slot* seg = segments[segment].load(std::memory_order_acquire);
+        if(seg != nullptr)
+            return seg;
+
+        // lost races just throw their copy away (same as Vector::alloc_bucket)
+        Slot* seg_new = new Slot[segment_size(segment)]();
+        if(!segments[segment].compare_exchange_strong(seg, seg_new, std::memory_order_acq_rel)){
+            delete[] seg_new;
+            return seg;
+        }
+        return seg_new;
+    }
+
+    Slot* at(size_t idx){
+        int seg = segment_of(idx);
+        return &segment(seg)[idx - segment_base(seg)];
+    }
+
+    // spins until we move the slot from `from` to BUSY, yielding so oversubscribed runs let the other side finish
+    static void acquire(Slot* slot, int from){
+        int expected = from;
+        while(!slot->state.compare_exchange_weak(expected, BUSY, std::memory_order_acquire, std::memory_order_relaxed)){
+            expected = from;
+            std::this_thread::yield();
+        }
+    }
+public:
+    SegmentedVector(size_t initial_size, size_t capacity) : capacity(capacity), size(initial_size){
+        assert(initial_size <= capacity);
+        for(int i=0; i<SEGMENTS; i++){
+            segments[i] = nullptr;
+        }
+
+        // same as reserve, alloc everything up front
+        if(capacity > 0){
+            for(int i=0; i<=segment_of(capacity-1); i++){
+                segment(i);
+            }
+        }
+
+        // the initial elements are there to be popped like any pushed one
+        for(size_t i=0; i<initial_size; i++){
+            at(i)->state.store(FULL, std::memory_order_relaxed);
+        }
+    }
+
+    ~SegmentedVector(){
+        for(int i=0; i<SEGMENTS; i++){
+            delete[] segments[i].load();
+        }
+    }
+
+    // every segment below capacity is already allocated so at() never has to
+    T read_at(size_t idx){
+        if(idx >= capacity)
+            return T();
+        return at(idx)->value.load(std::memory_order_relaxed);
+    }
+
+    void write_at(size_t idx, T val){
+        if(idx >= capacity)
+            return;
+        at(idx)->value.store(val, std::memory_order_relaxed);
+    }
+
+    void push_back(T elem){
+        size_t idx = size.fetch_add(1, std::memory_order_acq_rel);
+        Slot* slot = at(idx);
+
+        // a pop that claimed this index earlier may still be taking the old value out
+        acquire(slot, EMPTY);
+        slot->value.store(elem, std::memory_order_relaxed);
+        slot->state.store(FULL, std::memory_order_release);
+    }
+
+    T pop_back(){
+        size_t curr = size.load(std::memory_order_acquire);
+        while(curr > 0){
+            if(size.compare_exchange_weak(curr, curr-1, std::memory_order_acq_rel)){
+                Slot* slot = at(curr-1);
+
+                // the push that claimed this index may not have stored yet
+                acquire(slot, FULL);
+                T res = slot->value.load(std::memory_order_relaxed);
+                slot->state.store(EMPTY, std::memory_order_release);
+                return res;
+            }
+        }
+        return T();
+    }
+};
+};
+
+#endif
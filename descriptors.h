@@ -2,17 +2,18 @@
 #define DESCRIPTORS_H
 #include <iostream>
 #include <atomic>
+#include <cstdint>
 
 template <typename T>
 class WriteDescriptor{
 public:
     T old_val;
     T new_val;
-    int pos;
+    size_t pos;
     bool completed;
 
     WriteDescriptor<T>(){};
-    WriteDescriptor(T _old_val, T _new_val, int _pos)
+    WriteDescriptor(T _old_val, T _new_val, size_t _pos)
     : old_val(_old_val), new_val(_new_val), pos(_pos), completed(false){}
 
     void replace(WriteDescriptor<T> _new){
@@ -30,9 +31,12 @@ class Descriptor{
 public: 
     WriteDescriptor<T>* write = nullptr;
     size_t size;
+    // position in the chain of descriptors, used to order published snapshots
+    // atomic (always relaxed) since Vector::publish reads it off the live descriptor without taking a reference
+    std::atomic<uint64_t> seq;
 
-    Descriptor() : write(nullptr), size(0){};
-    Descriptor(WriteDescriptor<T>* _write, size_t _size): write(_write),size(_size){};
+    Descriptor() : write(nullptr), size(0), seq(0){};
+    Descriptor(WriteDescriptor<T>* _write, size_t _size, uint64_t _seq = 0): write(_write),size(_size),seq(_seq){};
 
     bool write_op_pending(){
         return (this->write != nullptr && !this->write->completed);
@@ -41,6 +45,7 @@ public:
     void replace(Descriptor<T>& _new){
         write = _new.write;
         size = _new.size;
+        seq.store(_new.seq.load(std::memory_order_relaxed), std::memory_order_relaxed);
     }
 };
 
@@ -0,0 +1,154 @@
+#ifndef LF_DEQUE_H
+#define LF_DEQUE_H
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include "lf_vec.h"
+
+namespace lockfree {
+// Chase-Lev work stealing deque (Le et al. "Correct and Efficient Work-Stealing for Weak Memory Models")
+// the owner thread pushes/pops at the bottom and any other thread can steal from the top
+//
+// we keep the geometric bucket table from Vector but use each bucket as one of Chase-Lev's circular arrays
+// bucket k is a ring of 2^(k+3) slots and top/bottom are wrapped into the current ring with a mask,
+// so memory tracks how many elements are live at once and not how many went through the deque
+//
+// when the live elements fill the ring the owner copies them into the next bucket and switches to it
+// the old bucket is never written again so a thief that still has it loaded reads the right value
+// (its CAS on top decides if that value was really still there), old buckets are only freed with the deque
+// so in total we hold on to less than 2x the ring size of the biggest live count we ever had
+template <typename T>
+class Deque {
+private:
+    // same layout as Vector::memory, only buckets 0..ring are ever allocated
+    std::atomic<std::atomic<T>*> memory[VEC_L1_MAX_SIZE];
+
+    // the bucket we are currently using as our ring, only the owner moves it
+    std::atomic<int> ring;
+
+    // top is only moved forward by steals (and the owner taking the last element)
+    // bottom is only touched by the owner
+    // these are logical indices and keep counting up, the slot is index & (ring size - 1)
+    // signed since the owner's pop can briefly take bottom below top
+    std::atomic<int64_t> top;
+    std::atomic<int64_t> bottom;
+
+    static size_t ring_size(int bucket){
+        return (size_t)0b1 << (bucket+POWER_ADJUSTMENT);
+    }
+
+    std::atomic<T>* at(int bucket, int64_t idx){
+        return &this->memory[bucket].load(std::memory_order_acquire)[(size_t)idx & (ring_size(bucket)-1)];
+    }
+
+    // only the owner grows the deque so unlike Vector::alloc_bucket we don't have to race for the slot
+    void alloc_bucket(int bucket){
+        this->memory[bucket].store(new std::atomic<T>[ring_size(bucket)], std::memory_order_release);
+    }
+
+    // owner only, copy the live elements [t, b) into the next bucket and make it the ring
+    int grow(int curr, int64_t t, int64_t b){
+        int next = curr + 1;
+        assert(next < VEC_L1_MAX_SIZE); // out of buckets
+
+        alloc_bucket(next);
+        for(int64_t i=t; i<b; i++){
+            at(next, i)->store(at(curr, i)->load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        this->ring.store(next, std::memory_order_release);
+        return next;
+    }
+
+public:
+    Deque() : ring(0), top(0), bottom(0){
+        for(int i=0;i<VEC_L1_MAX_SIZE;i++){
+            this->memory[i]=nullptr;
+        }
+        alloc_bucket(0);
+    }
+
+    ~Deque(){
+        for(int i=0;i<VEC_L1_MAX_SIZE;i++){
+            delete[] this->memory[i].load();
+        }
+    }
+
+    // owner only
+    void push(T elem){
+        int64_t b = this->bottom.load(std::memory_order_relaxed);
+        int64_t t = this->top.load(std::memory_order_acquire);
+        int curr = this->ring.load(std::memory_order_relaxed);
+
+        // full, the slot for b is still holding top
+        if(b - t > (int64_t)ring_size(curr) - 1){
+            curr = grow(curr, t, b);
+        }
+
+        at(curr, b)->store(elem, std::memory_order_relaxed);
+        // publish the element (and a new ring) before thieves can see the new bottom
+        std::atomic_thread_fence(std::memory_order_release);
+        this->bottom.store(b+1, std::memory_order_relaxed);
+    }
+
+    // owner only
+    // returns false if the deque was empty (or a thief beat us to the last element)
+    bool pop(T& out){
+        int64_t b = this->bottom.load(std::memory_order_relaxed) - 1;
+        int curr = this->ring.load(std::memory_order_relaxed);
+        this->bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = this->top.load(std::memory_order_relaxed);
+
+        // empty, restore bottom
+        if(t > b){
+            this->bottom.store(b+1, std::memory_order_relaxed);
+            return false;
+        }
+
+        out = at(curr, b)->load(std::memory_order_relaxed);
+        if(t < b){
+            return true;
+        }
+
+        // last element so we have to race the thieves for it through top
+        bool res = this->top.compare_exchange_strong(t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        this->bottom.store(b+1, std::memory_order_relaxed);
+        return res;
+    }
+
+    // any thread
+    // returns false if there was nothing to steal or we lost the race for it
+    bool steal(T& out){
+        int64_t t = this->top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = this->bottom.load(std::memory_order_acquire);
+
+        if(t >= b){
+            return false;
+        }
+
+        // loaded after bottom so we see any ring the element at t could have been copied into
+        int curr = this->ring.load(std::memory_order_acquire);
+        out = at(curr, t)->load(std::memory_order_relaxed);
+        return this->top.compare_exchange_strong(t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    // approximate, only meant for the owner/debugging
+    int64_t size(){
+        int64_t b = this->bottom.load(std::memory_order_relaxed);
+        int64_t t = this->top.load(std::memory_order_relaxed);
+        return b > t ? b - t : 0;
+    }
+
+    // bytes held by the allocated buckets (the current ring plus every ring we grew out of)
+    size_t memory_bytes(){
+        size_t bytes = 0;
+        for(int i=0;i<=this->ring.load(std::memory_order_relaxed);i++){
+            bytes += ring_size(i) * sizeof(std::atomic<T>);
+        }
+        return bytes;
+    }
+};
+};
+
+#endif
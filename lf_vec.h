@@ -3,10 +3,13 @@
 #include <cassert>
 #include <cmath>
 #include <atomic>
+#include <bit>
+#include <cstdint>
 #include <iostream>
 #include <thread>
 #include "descriptors.h"
 #include "mem_pool.h"
+#include "trace.h"
 
 // warning do not change this as it effects our alloc_bucket shifting
 // this change was because we were having indexing issues earlier in the implementation
@@ -18,7 +21,13 @@
 
 // setting our max L1 size because it grows exponentially with powers of 2
 // ie) our max size is = 2^1 + 2^2 + 2^3 + ... + 2^(MAX_L1_SIZE)
-#define VEC_L1_MAX_SIZE 32 - POWER_ADJUSTMENT - 1
+// sized for 64 bit indices, bucket k holds positions [2^(k+3), 2^(k+4)) (position = index + FIRST_BUCKET_SIZE)
+// so the last one holds [2^63, 2^64), way more than we will ever allocate but the table is only pointers
+// so the unused entries cost us nothing
+#define VEC_L1_MAX_SIZE (64 - POWER_ADJUSTMENT)
+
+// the highest index we can address, past it the position wraps around when we add FIRST_BUCKET_SIZE
+#define VEC_MAX_INDEX (SIZE_MAX - FIRST_BUCKET_SIZE)
 
 // max threads we are going to use on our vector
 // this is necessary for the pool since it needs to know how much memory to allocate up front
@@ -37,16 +46,36 @@ int MAX_POOLS = 1;
 // as stated in comments further down in the code
 #define POOL_SIZE 2*MAX_THREADS+1
 
+// lets push/pop resolve their slot through the thread's cached tail bucket (see tail_at)
+// only here so the benchmark can turn it off and compare
+bool TAIL_CURSOR = true;
+
+// lets push/pop publish the size for the read only observers (see Vector::publish)
+// only here so the benchmark can compare against producers that don't publish,
+// with it off size()/empty()/back() go through size_exact() so they still return the right thing
+bool PUBLISH_SNAPSHOT = true;
+
 thread_local int thread_id = -1;
 thread_local int thread_pool = -1;
-thread_local int thread_desc_mem_idx_LEAK = 0;
+thread_local size_t thread_desc_mem_idx_LEAK = 0;
+
+// the published snapshot (see Vector::publish) packs the low bits of the descriptor sequence number above the size
+// so it fits in one word observers can just load
+// 24 bits of sequence can only order publishers less than 8 million descriptor swaps apart,
+// publish() checks the full 64 bit sequence afterwards and fixes the snapshot up when a publisher was further behind
+// 40 bits of size is ~1 trillion elements, bigger sizes are published as SNAPSHOT_SIZE_OVERFLOW
+// and size() falls back to size_exact()
+#define SNAPSHOT_SIZE_BITS 40
+#define SNAPSHOT_SEQ_BITS (64 - SNAPSHOT_SIZE_BITS)
+#define SNAPSHOT_SIZE_OVERFLOW (((uint64_t)1 << SNAPSHOT_SIZE_BITS) - 1)
 
 // benchmark stuff (back practice but its okay I'm just trying to get this done...)
 constexpr int PER_THREAD_OPERATIONS = 500000;
 
 // NOTE:
 // we can replace the HighestBit instruciton with std::bit_width(x) in C++ 20
-int highest_bit(int x){
+// takes size_t so indices past 2^31 don't get truncated (still a single BSR/LZCNT)
+int highest_bit(size_t x){
     int res = std::__bit_width(x);
 
     // result is zero so we don't want to send negative index
@@ -58,15 +87,39 @@ int highest_bit(int x){
 }
 
 // alternative (untested) to __bit_width as some version don't allow it
-// int highest_bit(int x){
-//     for(int i=31; i>0; i--){
-//         if(x & (0b1<<i))
+// int highest_bit(size_t x){
+//     for(int i=63; i>0; i--){
+//         if(x & ((size_t)0b1<<i))
 //             return i;
 //     }
 //     return 0;
 // }
 
 namespace lockfree {
+// construction options for Vector
+struct VectorOptions {
+    // only create a threads pool the first time it pushes/pops instead of all MAX_POOLS up front
+    // (pool 0 is always created since it holds the initial descriptor)
+    // worth it when there are lots of small vectors that only a few threads ever write to
+    bool lazy_pools = false;
+};
+
+// what a Vector is holding on to, all in bytes unless it says slots
+// buckets are counted at their full size even if the OS hasn't backed every page yet
+struct MemoryStats {
+    size_t object_bytes = 0;     // the Vector itself (bucket table, pool pointers, padding, ...)
+    size_t bucket_bytes = 0;     // allocated buckets
+    size_t used_slots = 0;       // size()
+    size_t reserved_slots = 0;   // slots in the allocated buckets
+    size_t pool_bytes = 0;       // created pools and their nodes
+    size_t descriptor_bytes = 0; // LEAK descriptors (benchmark only)
+    size_t wasted_bytes = 0;     // allocated and then thrown away after losing an alloc race (cumulative)
+
+    size_t total_bytes() const {
+        return object_bytes + bucket_bytes + pool_bytes + descriptor_bytes;
+    }
+};
+
 // contains the logic and functions necessary to complete vector operations
 // what the user will use at an abstract level
 template <typename T>
@@ -79,9 +132,21 @@ private:
     std::atomic<Descriptor<T>*> _descriptor; // benchmarking with leaks
     Descriptor<T>* _descriptor_mem[ABS_MAX_THREADS];
     WriteDescriptor<T>* _write_descriptor_mem[ABS_MAX_THREADS];
+    size_t _descriptor_mem_size = 0; // per thread length of the arrays above
 
     std::atomic<mem::Node<T>*> descriptor;
 
+    // read only observers (size, empty, back) read this instead of fetching the descriptor
+    // so they never write to shared memory (no ref counting on the pool nodes)
+    // writers publish {seq, size} into it after their swap, see publish()
+    //
+    // it gets its own cache line (with allocated_slots, pools starts the next one) so observers
+    // polling it don't keep pulling the line the writers CAS descriptor on
+    alignas(64) std::atomic<uint64_t> snapshot{0};
+
+    // slots in the allocated buckets, bumped by whoever wins alloc_bucket
+    std::atomic<size_t> allocated_slots{0};
+
     // our memory pool
     // 
     // why is our memory complexity O(2*MAX_THREADS+1)?
@@ -100,20 +165,47 @@ private:
     
     // mega pool used for bench marking
     // id is the given thread
-    mem::Pool<T>* pools = new mem::Pool<T>[MAX_THREADS];
+    // only MAX_POOLS of these are ever created (or less with lazy_pools) and once set they never change
+    alignas(64) std::atomic<mem::Pool<T>*> pools[ABS_MAX_THREADS];
+    VectorOptions options;
+
+    // memory_stats bookkeeping
+    std::atomic<size_t> wasted_bytes{0};
+
+    // per thread cache of the bucket the tail currently lives in
+    // almost every push/pop lands within a few slots of the last one so we can skip
+    // the highest_bit translation + nullptr check and just do a compare and an add
+    //
+    // buckets are never freed or swapped once set, so the cached pointer can only go stale
+    // by belonging to another vector (vec_id) or by the tail leaving [base, bound)
+    struct TailCursor {
+        int vec_id = -1;
+        std::atomic<T>* bucket = nullptr;
+        size_t base = 0;  // first index stored in bucket
+        size_t bound = 0; // one past the last index stored in bucket
+    };
+    inline static thread_local TailCursor tail_cursor;
+    inline static std::atomic<int> next_vec_id{0};
+    int vec_id;
+
+    // optional, set to record every op into a trace (see trace.h)
+    // atomic so it can be swapped while threads are working, every op only does an acquire load
+    // (a plain load on x86) so a recorder set mid run is fully constructed when we see it
+    std::atomic<trace::Recorder*> recorder{nullptr};
     
 
     // indexes into our array at the specfic spot we need with clever bitwise operations
     // simply put, our bucket size grows in powers of 8 (assuming 8 is the first bucket size)
     // we can then use the MSB to mark the number of buckets we currently have in the array 
     // with that we can mask to find the specfic element in that array section for that bucket
-    std::atomic<T>* at(int idx){
-        int pos = idx + FIRST_BUCKET_SIZE; // get our requested position
+    std::atomic<T>* at(size_t idx){
+        assert(idx <= VEC_MAX_INDEX);
+        size_t pos = idx + FIRST_BUCKET_SIZE; // get our requested position
         int hibit = highest_bit(pos); 
 
         // translate this pos into an index for our array section in the bucket 
         // (trimming the MSB)
-        int new_idx = pos ^ (1<<hibit); // 1<<(hibit) = 2^(hibit) assuming hibit >= 1
+        size_t new_idx = pos ^ ((size_t)1<<hibit); // 1<<(hibit) = 2^(hibit) assuming hibit >= 1
         
         // printf("at(%d): bucket: %d | new_idx: %d\n",idx,hibit-highest_bit(FIRST_BUCKET_SIZE),new_idx);
         return &this->memory[hibit - highest_bit(FIRST_BUCKET_SIZE)][new_idx];
@@ -123,7 +215,7 @@ private:
     // new_bucket_size = FIRST_BUCKET_SIZE^(bucket+1)
     void alloc_bucket(int bucket){
         // int bucket_size = pow(FIRST_BUCKET_SIZE,bucket+1);
-        int bucket_size = 0b1 << (bucket+POWER_ADJUSTMENT); // we add 3 to it because we want to start our bucket off at 8
+        size_t bucket_size = (size_t)0b1 << (bucket+POWER_ADJUSTMENT); // we add 3 to it because we want to start our bucket off at 8
 
         std::atomic<T>* bucket_new = new std::atomic<T>[bucket_size]; // alloc new bucket
         std::atomic<T>* bucket_empty = nullptr; // empty bucket
@@ -134,18 +226,147 @@ private:
         // someone has already alloced this bucket
         if(!res){ 
             delete[] bucket_new;
+            this->wasted_bytes.fetch_add(bucket_size * sizeof(std::atomic<T>), std::memory_order_relaxed);
             return;
         }
+        this->allocated_slots.fetch_add(bucket_size, std::memory_order_release);
         // std::cout<<"alloced new bucket size "<<bucket_size<<" for bucket "<<bucket<<std::endl;
     }
 
+    // same as at() but goes through the threads tail cursor first
+    // only falls back to the full translation (and bucket alloc) when we cross into a new bucket
+    std::atomic<T>* tail_at(size_t idx){
+        assert(idx <= VEC_MAX_INDEX);
+
+        // cursor off, this is exactly what push/pop did before the cursor existed
+        if(!TAIL_CURSOR){
+            int bucket = highest_bit(idx + FIRST_BUCKET_SIZE) - highest_bit(FIRST_BUCKET_SIZE);
+            if(this->memory[bucket] == nullptr){
+                alloc_bucket(bucket);
+            }
+            return at(idx);
+        }
+
+        TailCursor& cursor = tail_cursor;
+        if(cursor.vec_id == this->vec_id && idx >= cursor.base && idx < cursor.bound){
+            return cursor.bucket + (idx - cursor.base);
+        }
+
+        int bucket = highest_bit(idx + FIRST_BUCKET_SIZE) - highest_bit(FIRST_BUCKET_SIZE);
+        if(this->memory[bucket] == nullptr){
+            alloc_bucket(bucket);
+        }
+
+        // bucket holds positions [2^(bucket+3), 2^(bucket+4)) which is idx + FIRST_BUCKET_SIZE
+        size_t bucket_size = (size_t)0b1 << (bucket+POWER_ADJUSTMENT);
+        cursor.vec_id = this->vec_id;
+        cursor.bucket = this->memory[bucket].load(std::memory_order_acquire);
+        cursor.base = bucket_size - FIRST_BUCKET_SIZE;
+        cursor.bound = cursor.base + bucket_size;
+
+        return cursor.bucket + (idx - cursor.base);
+    }
+
+    inline void trace_op(trace::Op op, uint64_t idx){
+        trace::Recorder* curr = this->recorder.load(std::memory_order_acquire);
+        if(curr != nullptr){
+            curr->record(thread_id, op, idx);
+        }
+    }
+
+    // pools only ever get set once so once we see one it is good forever
+    inline mem::Pool<T>& pool(int pool_id){
+        return *this->pools[pool_id].load(std::memory_order_acquire);
+    }
+
+    // creates the pool if it hasn't been yet (lazy_pools)
+    // racing threads that map to the same pool throw away their copy just like alloc_bucket
+    mem::Pool<T>& create_pool(int pool_id){
+        mem::Pool<T>* curr = this->pools[pool_id].load(std::memory_order_acquire);
+        if(curr != nullptr){
+            return *curr;
+        }
+
+        mem::Pool<T>* pool_new = new mem::Pool<T>(pool_id,POOL_SIZE);
+        if(!this->pools[pool_id].compare_exchange_strong(curr,pool_new,std::memory_order_acq_rel)){
+            this->wasted_bytes.fetch_add(pool_new->bytes(), std::memory_order_relaxed);
+            delete pool_new;
+            return *curr;
+        }
+        return *pool_new;
+    }
+
+    static inline uint64_t pack_snapshot(uint64_t seq, size_t size){
+        constexpr uint64_t seq_mask = ((uint64_t)1 << SNAPSHOT_SEQ_BITS) - 1;
+        return ((seq & seq_mask) << SNAPSHOT_SIZE_BITS) | (size < SNAPSHOT_SIZE_OVERFLOW ? size : SNAPSHOT_SIZE_OVERFLOW);
+    }
+
+    // snapshot of the descriptor that is current right now (leak picks the LEAK chain), with its write completed
+    uint64_t live_snapshot(bool leak, uint64_t& seq){
+        if(leak){
+            Descriptor<T>* desc = this->_descriptor.load(std::memory_order_acquire);
+            complete_write(desc->write);
+            seq = desc->seq.load(std::memory_order_relaxed);
+            return pack_snapshot(seq, desc->size);
+        }
+
+        mem::Node<T>* node = fetch_descriptor();
+        complete_write(node->desc.write);
+        seq = node->desc.seq.load(std::memory_order_relaxed);
+        uint64_t snap = pack_snapshot(seq, node->desc.size);
+        pool(node->pool_id).release(node->id);
+        return snap;
+    }
+
+    // publish the state of a descriptor for the observers
+    // only call once that descriptor's write (if any) is complete so back() never sees a stale slot
+    //
+    // publishers can be delayed so we only move the snapshot forward, newer is decided by the
+    // sequence number modulo 2^SNAPSHOT_SEQ_BITS which is only right while we are less than half that behind
+    // so once we are in we check how far behind the live descriptor we really are, and if it is more than
+    // a quarter we put the live descriptor's state in over ours (and check that one again)
+    // every thread publishes before its next swap so whoever publishes after us swapped in after the
+    // descriptor we checked, nowhere near half the window ahead of what we leave in the snapshot
+    void publish(uint64_t seq, size_t size, bool leak){
+        if(!PUBLISH_SNAPSHOT){
+            return;
+        }
+
+        constexpr uint64_t seq_mask = ((uint64_t)1 << SNAPSHOT_SEQ_BITS) - 1;
+        uint64_t snap_new = pack_snapshot(seq, size);
+
+        uint64_t snap_curr = this->snapshot.load(std::memory_order_relaxed);
+        while(true){
+            uint64_t ahead = (seq - (snap_curr >> SNAPSHOT_SIZE_BITS)) & seq_mask;
+            if(ahead == 0 || ahead >= ((uint64_t)1 << (SNAPSHOT_SEQ_BITS-1))){
+                return; // someone already published this state or a newer one
+            }
+            if(this->snapshot.compare_exchange_weak(snap_curr, snap_new, std::memory_order_release, std::memory_order_relaxed)){
+                break;
+            }
+        }
+
+        // no reference is taken on the live descriptor, if its node gets recycled under us
+        // the sequence number we read is only ever bigger (and the fix up takes a proper reference)
+        Descriptor<T>* live = leak ? this->_descriptor.load(std::memory_order_acquire) : &this->descriptor.load(std::memory_order_acquire)->desc;
+        while(live->seq.load(std::memory_order_relaxed) - seq >= ((uint64_t)1 << (SNAPSHOT_SEQ_BITS-2))){
+            uint64_t snap_live = live_snapshot(leak, seq);
+            // if someone already replaced us they run this same check for themselves
+            if(!this->snapshot.compare_exchange_strong(snap_new, snap_live, std::memory_order_release, std::memory_order_relaxed)){
+                return;
+            }
+            snap_new = snap_live;
+            live = leak ? this->_descriptor.load(std::memory_order_acquire) : &this->descriptor.load(std::memory_order_acquire)->desc;
+        }
+    }
+
     mem::Node<T>* fetch_descriptor() {
         while (true) {
             // fetch local copy
             mem::Node<T>* node = this->descriptor.load(std::memory_order_acquire);
 
             // attempt to insert our reference on the block
-            node = this->pools[node->pool_id].alloc(node->id);
+            node = this->pool(node->pool_id).alloc(node->id);
 
             // check to make sure descriptor didn't change
             // if it did then our reference will be invalid
@@ -154,13 +375,13 @@ private:
             }
 
             // Someone else swapped it — roll back our reference
-            pools[node->pool_id].release(node->id);
+            pool(node->pool_id).release(node->id);
         }
     }
 
     void complete_write(WriteDescriptor<T>* write_op){
         if(write_op != nullptr && !write_op->completed){
-            at(write_op->pos)->compare_exchange_strong(write_op->old_val,write_op->new_val);
+            tail_at(write_op->pos)->compare_exchange_strong(write_op->old_val,write_op->new_val);
             write_op->completed = true;
         }
     }
@@ -170,48 +391,92 @@ private:
     // meaning we need to drop the current Thread and the Vector Descriptor
     // since it moved
     inline void swapped_desc(int pool_id, int desc_id) {
-        pools[pool_id].release(desc_id);
-        pools[pool_id].release(desc_id); 
-    }
-
-    // alloc all of our buckets so we don't have to worry about memory allocation in our algorithms
-    void alloc_buckets_bench_mark(){
-        for(int bucket_id=1; bucket_id<VEC_L1_MAX_SIZE; bucket_id++){
-            this->alloc_bucket(bucket_id);
-        }
+        pool(pool_id).release(desc_id);
+        pool(pool_id).release(desc_id); 
     }
 
-    void alloc_descriptor_mem_blocks(int per_thread_operations){
-        int overflow_buff = 500;
-        int arr_size = per_thread_operations+overflow_buff; 
+    // extra is room past what a thread's own ops can reach, init_for_benchmarks pushes its initial
+    // elements from the end of thread 0's arrays so they never collide with thread 0's ops
+    void alloc_descriptor_mem_blocks(size_t per_thread_operations, size_t extra = 0){
+        size_t overflow_buff = 500;
+        size_t arr_size = per_thread_operations+overflow_buff+extra; 
 
+        this->_descriptor_mem_size = arr_size;
         for(int i=0; i<MAX_THREADS;i++){
             this->_descriptor_mem[i] = new Descriptor<T>[arr_size];
             this->_write_descriptor_mem[i] = new WriteDescriptor<T>[arr_size];
         } 
     }
 public:
-    Vector(){
+    Vector(VectorOptions options = VectorOptions()) : options(options), vec_id(next_vec_id.fetch_add(1)){
         // defaulting the pointer to NULL for easy alloc_bucket operations
         for(int i=0;i<VEC_L1_MAX_SIZE;i++){
             this->memory[i]=nullptr;
         }
+        for(int i=0;i<ABS_MAX_THREADS;i++){
+            this->pools[i]=nullptr;
+            this->_descriptor_mem[i]=nullptr;
+            this->_write_descriptor_mem[i]=nullptr;
+        }
 
-        // allocate our pools
-        for(int pool_id=0; pool_id<MAX_POOLS;pool_id++){
-            pools[pool_id] = mem::Pool<T>(pool_id,POOL_SIZE);
+        // allocate our pools (just the first one if lazy)
+        int eager_pools = options.lazy_pools ? 1 : MAX_POOLS;
+        for(int pool_id=0; pool_id<eager_pools;pool_id++){
+            create_pool(pool_id);
         }
 
         // init our first bucket
         alloc_bucket(0);
-        this->descriptor.store(pools[0].alloc()); // give thread 0 descriptor reference
+        this->descriptor.store(pool(0).alloc()); // give thread 0 descriptor reference
         this->_descriptor.store(new Descriptor<T>(nullptr,0));
     }
 
+    // allocates every bucket needed to hold indices [0, capacity)
+    // (3.3 reserve) so later operations in that range never have to allocate
+    void reserve(size_t capacity){
+        if(capacity == 0){
+            return;
+        }
+
+        assert(capacity - 1 <= VEC_MAX_INDEX);
+        int last_bucket = highest_bit(capacity - 1 + FIRST_BUCKET_SIZE) - highest_bit(FIRST_BUCKET_SIZE);
+        for(int bucket_id=0; bucket_id<=last_bucket; bucket_id++){
+            if(this->memory[bucket_id] == nullptr){
+                this->alloc_bucket(bucket_id);
+            }
+        }
+    }
+
     // this function is used to inti ourselves for benchmarking purposes
-    void init_for_benchmarks(int per_thread_operations){
-        alloc_buckets_bench_mark();
-        alloc_descriptor_mem_blocks(per_thread_operations);
+    // we used to alloc every bucket here but with 64 bit indexing that is no longer possible
+    // so we only reserve what every thread pushing every op could reach
+    //
+    // initial_size default elements are pushed through both the normal and the LEAK path first
+    // so we start out like the baselines do (see baselines.h) and early pops have something to take
+    // call it from a thread that isn't going to run ops, it is left as thread 0
+    void init_for_benchmarks(size_t per_thread_operations, size_t initial_size = 0){
+        reserve(initial_size + per_thread_operations * MAX_THREADS);
+        alloc_descriptor_mem_blocks(per_thread_operations, initial_size);
+
+        set_id(0);
+        thread_desc_mem_idx_LEAK = this->_descriptor_mem_size - initial_size;
+        for(size_t i=0; i<initial_size; i++){
+            push_back(T());
+            push_back_LEAK(T());
+        }
+        thread_desc_mem_idx_LEAK = 0;
+    }
+
+    // also benchmarking only, starts us off at size without pushing everything below it
+    // so the push/pop path can be checked at huge indices (past 2^32) in a few ops
+    // call it before any thread touches the vector, the skipped slots are never allocated
+    // so only indices >= size can be accessed afterwards (push/pop alloc their buckets through tail_at)
+    void init_size_for_benchmarks(size_t size){
+        mem::Node<T>* node = this->descriptor.load();
+        Descriptor<T> desc_new = Descriptor<T>(nullptr, size, node->desc.seq.load(std::memory_order_relaxed) + 1);
+        node->desc.replace(desc_new);
+        this->_descriptor.load()->size = size;
+        publish(desc_new.seq.load(std::memory_order_relaxed), size, false);
     }
 
     void push_back_LEAK(T elem){
@@ -225,29 +490,27 @@ public:
 
             complete_write(desc_curr->write);
 
-            int bucket = highest_bit(desc_curr->size + FIRST_BUCKET_SIZE) - highest_bit(FIRST_BUCKET_SIZE);
-            // std::cout<<"pushing on bucket "<<bucket<<std::endl;
-
-            if(this->memory[bucket] == nullptr){
-                alloc_bucket(bucket);
-            }
-
             // WriteDescriptor<T>* write_op = new WriteDescriptor<T>(*at(desc_curr->size), elem, desc_curr->size);
             // Descriptor<T>* desc_new = new Descriptor(write_op, desc_curr->size + 1);
-            write_op->old_val = *at(desc_curr->size);
+            write_op->old_val = *tail_at(desc_curr->size); // allocs the bucket if needed
             write_op->new_val = elem;
             write_op->pos = desc_curr->size;
             write_op->completed = false;
 
             desc_new->size = desc_curr->size + 1;
             desc_new->write = write_op;
+            desc_new->seq.store(desc_curr->seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
 
             if(this->_descriptor.compare_exchange_strong(desc_curr,desc_new)){
                 break;
             }
         }   
 
-        complete_write(this->_descriptor.load()->write);
+        // LEAK descriptors are never reused so we can publish whatever is current
+        Descriptor<T>* desc_done = this->_descriptor.load();
+        complete_write(desc_done->write);
+        publish(desc_done->seq.load(std::memory_order_relaxed), desc_done->size, true);
+        trace_op(trace::Op::Push, write_op->pos);
     }
 
     T pop_back_LEAK(){
@@ -261,15 +524,19 @@ public:
             // prevent seg faults idk if this is the best for partical use
             // would have to add errrors or something, but this is for testing
             if(desc_curr->size == 0){                
-                return *at(desc_curr->size);
+                trace_op(trace::Op::Pop, 0);
+                return *tail_at(desc_curr->size);
             }
 
-            T res = *at(desc_curr->size - 1);
+            T res = *tail_at(desc_curr->size - 1);
             // Descriptor<T>* desc_new = new Descriptor<T>(nullptr,desc_curr->size-1);
             desc_new->write = nullptr;
             desc_new->size = desc_curr->size-1;
+            desc_new->seq.store(desc_curr->seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
 
             if(this->_descriptor.compare_exchange_strong(desc_curr,desc_new)){
+                publish(desc_new->seq.load(std::memory_order_relaxed), desc_new->size, true);
+                trace_op(trace::Op::Pop, desc_new->size);
                 return res;
             }
 
@@ -278,22 +545,17 @@ public:
 
     // vector functions
     void push_back(T elem){
-        mem::Node<T>* thread_node = pools[thread_pool].alloc(); // fetch our block
+        mem::Node<T>* thread_node = create_pool(thread_pool).alloc(); // fetch our block
         while(true){
             mem::Node<T>* curr_node = fetch_descriptor(); // fetch our descriptor (+1 ref)
             Descriptor<T>* desc_curr = &curr_node->desc; // grab desc
  
             complete_write(desc_curr->write);
 
-            // bucket logic
-            int bucket = highest_bit(desc_curr->size + FIRST_BUCKET_SIZE) - highest_bit(FIRST_BUCKET_SIZE);
-            if(this->memory[bucket] == nullptr){
-                alloc_bucket(bucket);
-            }
-
+            // bucket logic (tail_at allocs the bucket if we just crossed into it)
             // new descriptors (local copies)
-            WriteDescriptor<T> write_op = WriteDescriptor<T>(*at(desc_curr->size), elem, desc_curr->size);
-            Descriptor<T> desc_new = Descriptor(&thread_node->write, desc_curr->size + 1);
+            WriteDescriptor<T> write_op = WriteDescriptor<T>(*tail_at(desc_curr->size), elem, desc_curr->size);
+            Descriptor<T> desc_new = Descriptor(&thread_node->write, desc_curr->size + 1, desc_curr->seq.load(std::memory_order_relaxed) + 1);
             
             // insert our local copies into our memory block
             thread_node->write.replace(write_op); 
@@ -309,20 +571,23 @@ public:
                 // we don't need to add a new reference for the vector descriptor
                 // since we will just reuse our reference when fetching the local copy (thread_node)
                 swapped_desc(curr_node->pool_id,curr_node->id);
+                trace_op(trace::Op::Push, write_op.pos);
                 break;
             }
 
             // we failed the CAS so we could drop this reference
-            pools[old_desc_node->pool_id].release(old_desc_node->id);
+            pool(old_desc_node->pool_id).release(old_desc_node->id);
         }   
 
         mem::Node<T>* curr = fetch_descriptor();
         complete_write(&curr->write);
-        pools[curr->pool_id].release(curr->id);
+        // we still hold our reference on curr so its fields can't be recycled under us
+        publish(curr->desc.seq.load(std::memory_order_relaxed), curr->desc.size, false);
+        pool(curr->pool_id).release(curr->id);
     }
 
     T pop_back(){
-        mem::Node<T>* thread_node = pools[thread_pool].alloc(); // fetch our block
+        mem::Node<T>* thread_node = create_pool(thread_pool).alloc(); // fetch our block
         while(true){
             mem::Node<T>* curr_node = fetch_descriptor();
             Descriptor<T>* desc_curr = &curr_node->desc;
@@ -332,50 +597,125 @@ public:
             // prevent seg faults idk if this is the best for partical use
             // would have to add errrors or something, but this is for testing
             if(desc_curr->size <= 0){
-                pools[curr_node->pool_id].release(curr_node->id);
-                pools[thread_node->pool_id].release(thread_node->id);
-                return *at(desc_curr->size);
+                pool(curr_node->pool_id).release(curr_node->id);
+                pool(thread_node->pool_id).release(thread_node->id);
+                trace_op(trace::Op::Pop, 0);
+                return *tail_at(desc_curr->size);
             }
 
-            T res = *at(desc_curr->size - 1);
+            T res = *tail_at(desc_curr->size - 1);
 
-            Descriptor<T> desc_new = Descriptor<T>(nullptr,desc_curr->size-1);
+            Descriptor<T> desc_new = Descriptor<T>(nullptr,desc_curr->size-1,desc_curr->seq.load(std::memory_order_relaxed)+1);
             thread_node->desc.replace(desc_new);
 
             mem::Node<T>* old = curr_node;
             if(this->descriptor.compare_exchange_strong(curr_node,thread_node)){
                 swapped_desc(curr_node->pool_id,curr_node->id);
+                publish(desc_new.seq.load(std::memory_order_relaxed), desc_new.size, false);
+                trace_op(trace::Op::Pop, desc_new.size);
                 return res;
             }
 
-            pools[old->pool_id].release(old->id);
+            pool(old->pool_id).release(old->id);
         }
     }
 
     // random accesses
     void write_at(size_t idx, T val){
         at(idx)->store(val);
+        trace_op(trace::Op::Write, idx);
     }
 
     T read_at(size_t idx){
+        trace_op(trace::Op::Read, idx);
         return at(idx)->load();
     }
 
-    // other 
+    // read only observers
+    // these only do acquire loads of the published snapshot and never write to shared memory
+    // so monitoring threads can poll them without slowing the writers down
+    // the snapshot can trail the descriptor by the ops still publishing, use size_exact() if that matters
+    // (with PUBLISH_SNAPSHOT off or a size past SNAPSHOT_SIZE_BITS they fall back to size_exact())
     size_t size(){
+        if(!PUBLISH_SNAPSHOT){
+            return size_exact(); // nothing is being published
+        }
+
+        uint64_t size = this->snapshot.load(std::memory_order_acquire) & SNAPSHOT_SIZE_OVERFLOW;
+        if(size == SNAPSHOT_SIZE_OVERFLOW){
+            return size_exact(); // too big for the snapshot
+        }
+        return size;
+    }
+
+    bool empty(){
+        return size() == 0;
+    }
+
+    // like pop_back, returns whatever is in slot 0 when we are empty
+    // the slot can be popped/overwritten right after we read the size, buckets are never freed so this is always safe memory
+    T back(){
+        size_t curr_size = size();
+        return at(curr_size == 0 ? 0 : curr_size - 1)->load(std::memory_order_acquire);
+    }
+
+    // slots we can hold without allocating another bucket
+    size_t capacity(){
+        return this->allocated_slots.load(std::memory_order_acquire);
+    }
+
+    // other 
+    // size straight from the current descriptor (takes a pool reference)
+    size_t size_exact(){
         mem::Node<T>* block = fetch_descriptor();
         size_t size = block->desc.size;
 
         // pending...
         if(block->desc.write_op_pending()){
-            pools[block->pool_id].release(block->id);
+            pool(block->pool_id).release(block->id);
             return size-1;
         }
 
-        pools[block->pool_id].release(block->id);
+        pool(block->pool_id).release(block->id);
         return size;
     } 
 
+    // how much memory we are holding on to right now (see MemoryStats)
+    // safe to call while other threads are working, the numbers are just a snapshot
+    MemoryStats memory_stats(){
+        MemoryStats stats;
+
+        stats.object_bytes = sizeof(*this);
+        stats.reserved_slots = capacity();
+        stats.bucket_bytes = stats.reserved_slots * sizeof(std::atomic<T>);
+        stats.used_slots = size();
+
+        for(int pool_id=0; pool_id<ABS_MAX_THREADS; pool_id++){
+            mem::Pool<T>* curr = this->pools[pool_id].load(std::memory_order_acquire);
+            if(curr != nullptr){
+                stats.pool_bytes += curr->bytes();
+            }
+        }
+
+        // the LEAK descriptor arrays plus the initial LEAK descriptor
+        stats.descriptor_bytes = sizeof(Descriptor<T>);
+        for(int i=0; i<ABS_MAX_THREADS; i++){
+            if(this->_descriptor_mem[i] != nullptr){
+                stats.descriptor_bytes += this->_descriptor_mem_size * (sizeof(Descriptor<T>) + sizeof(WriteDescriptor<T>));
+            }
+        }
+
+        stats.wasted_bytes = this->wasted_bytes.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    // start/stop recording ops into recorder (nullptr stops), safe while other threads are working
+    // ops already in flight can still record into the old one, so it has to outlive them
+    // and have a log for every thread id we hand out
+    void set_recorder(trace::Recorder* recorder){
+        this->recorder.store(recorder, std::memory_order_release);
+    }
+
     void set_id(int id){
         thread_id = id;
         thread_pool = thread_id % MAX_POOLS;
@@ -8,27 +8,52 @@
 #include <string>
 #include <algorithm>
 #include <map>
+#include <deque>
 
 
 #include "descriptors.h"
 #include "lf_vec.h"
+#include "lf_deque.h"
+#include "baselines.h"
 
-enum class Op {
-    Read,
-    Write,
-    Push,
-    Pop 
-};
+// shared with the trace format so recorded ops map straight back onto our ops
+using Op = trace::Op;
 
 int SEED = 42;
 // int PER_THREAD_OPERATIONS = 500000;
 bool LF = false;
 bool LEAK = false;
+bool DEQUE = false;
+int DEQUE_DEPTH = 20; // fork-join tree depth, each run executes 2^(depth+1)-1 tasks
+long DEQUE_STEADY = 0; // steady state push/steal check (ops, 0 = off)
+int DEQUE_LIVE = 64; // elements the owner keeps in the deque during the steady state check
+
+// trace recording / replay
+const char* RECORD_PATH = nullptr;
+const char* REPLAY_PATH = nullptr;
+bool REPLAY_ASAP = false; // ignore the recorded timing and replay as fast as possible
+trace::Trace replay_trace;
+
+// 64 bit capacity run (0 = off)
+size_t CAPACITY = 0;
+bool CAPACITY_FILL = false; // push every element instead of just reserving and probing
+
+// memory accounting
+bool LAZY_POOLS = false;
+bool PRINT_MEMORY = false; // print lf_vec.memory_stats() after the run
+
+// observer threads polling size()/empty()/back() while the -lf producers run
+int OBSERVERS = 0;
+bool OBSERVE_EXACT = false; // poll size_exact() (pool references) instead of the published snapshot, and don't publish it
+std::atomic<bool> observers_done;
+std::atomic<size_t> observed; // what the observers read, summed so their loops can't be optimized out
+
+// which non lock free vector -l runs (see baselines.h)
+// mtx | shared | spin | striped | segmented
+std::string BACKEND = "mtx";
 
 int VEC_SIZE = PER_THREAD_OPERATIONS * MAX_THREADS * 2;
 
-std::mutex mtx;
-std::vector<int> locked_vector(VEC_SIZE);
 std::vector<std::thread> threads;
 std::vector<std::vector<Op>> sequences;
 
@@ -36,7 +61,8 @@ std::vector<std::vector<Op>> sequences;
 // distribtuion logic
 std::random_device rd;
 std::mt19937 gen(rd()); // Mersenne Twister engine
-std::uniform_int_distribution<> distrib(1, 1000);
+constexpr int RANDOM_ACCESS_RANGE = 1000;
+std::uniform_int_distribution<> distrib(1, RANDOM_ACCESS_RANGE);
 
 
 
@@ -78,8 +104,38 @@ std::vector<Op> generate_operation_sequence(
     return sequence;
 }
 
+// index for a random access op, push/pop don't use one
+inline size_t random_idx(Op op){
+    return (op == Op::Read || op == Op::Write) ? distrib(gen) : 0;
+}
+
+void lf_apply(int thread_id, lockfree::Vector<int>& lf_vec, Op curr_op, size_t idx){
+    int v;
+    switch(curr_op){
+        case Op::Read:
+            v = lf_vec.read_at(idx);
+        break;
+        case Op::Write:
+            lf_vec.write_at(idx,thread_id);
+        break;
+        case Op::Pop:
+            if(LEAK){
+                lf_vec.pop_back_LEAK();
+            }else{
+                lf_vec.pop_back();
+            }
+        break;
+        case Op::Push:
+            if(LEAK){
+                lf_vec.push_back_LEAK(thread_id);
+            }else{
+                lf_vec.push_back(thread_id);
+            }
+        break;
+    }
+}
+
 void lf_work(int thread_id,lockfree::Vector<int>& lf_vec){
-    int v; 
     std::vector<Op>& sequence = sequences[thread_id];
 
     lf_vec.set_id(thread_id);
@@ -87,57 +143,413 @@ void lf_work(int thread_id,lockfree::Vector<int>& lf_vec){
         Op curr_op = sequence.back();
         sequence.pop_back();
 
-        switch(curr_op){
-            case Op::Read:
-                v = lf_vec.read_at(distrib(gen));
-            break;
-            case Op::Write:
-                lf_vec.write_at(distrib(gen),thread_id);
-            break;
-            case Op::Pop:
-                if(LEAK){
-                    lf_vec.pop_back_LEAK();
-                }else{
-                    lf_vec.pop_back();
-                }
-            break;
-            case Op::Push:
-                if(LEAK){
-                    lf_vec.push_back_LEAK(thread_id);
-                }else{
-                    lf_vec.push_back(thread_id);
-                }
-            break;
-        }
+        lf_apply(thread_id, lf_vec, curr_op, random_idx(curr_op));
     }
 }
 
-void mtx_work(int thread_id){
+// the non lock free vectors (see baselines.h), all of them share the same ops
+template <typename V>
+void baseline_apply(int thread_id, V& vec, Op curr_op, size_t idx){
     int v;
+    switch(curr_op){
+        case Op::Read:
+            v = vec.read_at(idx);
+        break;
+        case Op::Write:
+            vec.write_at(idx,thread_id);
+        break;
+        case Op::Pop:
+            vec.pop_back();
+        break;
+        case Op::Push:
+            vec.push_back(thread_id);
+        break;
+    }
+}
+
+template <typename V>
+void baseline_work(int thread_id, V& vec){
     std::vector<Op>& sequence = sequences[thread_id];
 
     while(!sequence.empty()){
         Op curr_op = sequence.back();
         sequence.pop_back();
 
-        mtx.lock();
-        switch(curr_op){
-            case Op::Read:
-                v = locked_vector[distrib(gen)];
-            break;
-            case Op::Write:
-                locked_vector[distrib(gen)] = 10;
-            break;
-            case Op::Pop:
-                if(locked_vector.size()>0)
-                    locked_vector.pop_back();
-            break;
-            case Op::Push:
-                locked_vector.push_back(1);
+        baseline_apply(thread_id, vec, curr_op, random_idx(curr_op));
+    }
+}
+
+// streams this threads ops straight out of the mapped trace
+// unless REPLAY_ASAP each op waits until the same time after the previous one as when it was recorded
+// start is shared by all threads so their relative timing matches the recording as well
+template <typename F>
+void replay_stream(int thread_id, std::chrono::steady_clock::time_point start, F apply){
+    const trace::Record* records = replay_trace.records(thread_id);
+    uint64_t count = replay_trace.count(thread_id);
+
+    auto target = start;
+    for(uint64_t i=0; i<count; i++){
+        const trace::Record& rec = records[i];
+        if(!REPLAY_ASAP){
+            target += std::chrono::nanoseconds(rec.delta_ns);
+            while(std::chrono::steady_clock::now() < target){
+                std::this_thread::yield();
+            }
+        }
+        apply(rec.op, rec.idx);
+    }
+}
+
+void lf_replay_work(int thread_id, std::chrono::steady_clock::time_point start, lockfree::Vector<int>& lf_vec){
+    lf_vec.set_id(thread_id);
+    replay_stream(thread_id, start, [&](Op op, size_t idx){
+        lf_apply(thread_id, lf_vec, op, idx);
+    });
+}
+
+template <typename V>
+void baseline_replay_work(int thread_id, std::chrono::steady_clock::time_point start, V& vec){
+    replay_stream(thread_id, start, [&](Op op, size_t idx){
+        baseline_apply(thread_id, vec, op, idx);
+    });
+}
+
+// runs the op sequences (or the replay) over a fresh V and returns how long it took in ms
+// every backend starts with the random access range filled in and VEC_SIZE reserved
+template <typename V>
+long run_baseline(){
+    V vec(RANDOM_ACCESS_RANGE+1, VEC_SIZE);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto replay_start = std::chrono::steady_clock::now();
+    for(int i=0;i<MAX_THREADS; i++){
+        if(REPLAY_PATH != nullptr){
+            threads.push_back(std::thread(baseline_replay_work<V>,i,replay_start,std::ref(vec)));
+        }else{
+            threads.push_back(std::thread(baseline_work<V>,i,std::ref(vec)));
+        }
+    }
+
+    for(int i=0;i<threads.size();i++){
+        threads[i].join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count();
+}
+
+void observer_work(lockfree::Vector<int>& lf_vec){
+    size_t seen = 0;
+    while(!observers_done.load(std::memory_order_relaxed)){
+        if(OBSERVE_EXACT){
+            seen += lf_vec.size_exact();
+        }else{
+            seen += lf_vec.size() + lf_vec.empty() + lf_vec.back();
+        }
+    }
+    observed.fetch_add(seen, std::memory_order_relaxed);
+}
+
+long run_lf(lockfree::Vector<int>& lf_vec, trace::Recorder* recorder){
+    // observers aren't counted in the time, we only care how much they slow the producers down
+    std::vector<std::thread> observers;
+    observers_done = false;
+    for(int i=0; i<OBSERVERS; i++){
+        observers.push_back(std::thread(observer_work,std::ref(lf_vec)));
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto replay_start = std::chrono::steady_clock::now();
+    // recording and replay share this time origin so the first op of each thread
+    // isn't charged with the setup before the run
+    if(recorder != nullptr){
+        recorder->start(replay_start);
+    }
+    for(int i=0;i<MAX_THREADS; i++){
+        if(REPLAY_PATH != nullptr){
+            threads.push_back(std::thread(lf_replay_work,i,replay_start,std::ref(lf_vec)));
+        }else{
+            threads.push_back(std::thread(lf_work,i,std::ref(lf_vec)));
+        }
+    }
+
+    for(int i=0;i<threads.size();i++){
+        threads[i].join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    observers_done = true;
+    for(int i=0;i<observers.size();i++){
+        observers[i].join();
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count();
+}
+
+// the mutex deque we are comparing lockfree::Deque against
+// same interface, owner push/pop at the back and thieves steal from the front
+class MutexDeque {
+private:
+    std::mutex mtx;
+    std::deque<int> tasks;
+public:
+    void push(int elem){
+        std::lock_guard<std::mutex> lock(mtx);
+        tasks.push_back(elem);
+    }
+
+    bool pop(int& out){
+        std::lock_guard<std::mutex> lock(mtx);
+        if(tasks.empty())
+            return false;
+        out = tasks.back();
+        tasks.pop_back();
+        return true;
+    }
+
+    bool steal(int& out){
+        std::lock_guard<std::mutex> lock(mtx);
+        if(tasks.empty())
+            return false;
+        out = tasks.front();
+        tasks.pop_front();
+        return true;
+    }
+};
+
+std::atomic<long> tasks_remaining;
+
+// fork-join workload: a task of depth d forks two tasks of depth d-1
+// threads run their own tasks and steal from a random victim when they run dry
+template <typename D>
+void fork_join_work(int thread_id, std::vector<D*>& deques){
+    D& own = *deques[thread_id];
+    std::mt19937 rng(SEED+thread_id);
+    int task;
+
+    while(tasks_remaining.load(std::memory_order_relaxed) > 0){
+        if(!own.pop(task)){
+            int victim = rng() % MAX_THREADS;
+            if(victim == thread_id || !deques[victim]->steal(task))
+                continue;
+        }
+
+        if(task > 0){
+            own.push(task-1);
+            own.push(task-1);
+        }
+        tasks_remaining.fetch_sub(1,std::memory_order_relaxed);
+    }
+}
+
+template <typename D>
+void run_fork_join(){
+    std::vector<D*> deques;
+    for(int i=0; i<MAX_THREADS; i++){
+        deques.push_back(new D());
+    }
+    tasks_remaining = (2L << DEQUE_DEPTH) - 1;
+    deques[0]->push(DEQUE_DEPTH); // root task, everyone else has to steal to get work
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for(int i=0;i<MAX_THREADS; i++){
+        threads.push_back(std::thread(fork_join_work<D>,i,std::ref(deques)));
+    }
+
+    for(int i=0;i<threads.size();i++){
+        threads[i].join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end-start);
+    std::cout<<"Threads: "<<MAX_THREADS<<"\tTotal Time: "<<duration.count()<<"ms\n";
+
+    for(D* deque : deques){
+        delete deque;
+    }
+}
+
+// steady state check for lockfree::Deque
+// the owner keeps about DEQUE_LIVE elements in the deque while a thief steals ops of them
+// the deque's memory has to stop growing once it fits DEQUE_LIVE, no matter how many ops go through it
+int run_deque_steady(long ops){
+    lockfree::Deque<int> deque;
+    std::atomic<long> stolen{0};
+    std::atomic<long> stolen_sum{0};
+    std::atomic<bool> done{false};
+
+    std::thread thief([&](){
+        int val;
+        while(!done.load(std::memory_order_relaxed)){
+            if(deque.steal(val)){
+                stolen_sum.fetch_add(val, std::memory_order_relaxed);
+                stolen.fetch_add(1, std::memory_order_relaxed);
+            }else{
+                std::this_thread::yield(); // let the owner refill us
+            }
+        }
+    });
+
+    auto start = std::chrono::high_resolution_clock::now();
+    long pushed = 0;
+    long pushed_sum = 0;
+    size_t warm_bytes = 0;
+    while(stolen.load(std::memory_order_relaxed) < ops){
+        if(deque.size() < DEQUE_LIVE){
+            int val = pushed % 1000;
+            deque.push(val);
+            pushed++;
+            pushed_sum += val;
+        }else{
+            std::this_thread::yield();
+        }
+
+        // by now we have been through the deque's ring many times over
+        if(pushed == DEQUE_LIVE * 16 && warm_bytes == 0){
+            warm_bytes = deque.memory_bytes();
+        }
+    }
+    done = true;
+    thief.join();
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end-start);
+    std::cout<<"Threads: 2\tTotal Time: "<<duration.count()<<"ms\n";
+
+    // whatever is left over goes back through the owner
+    long popped_sum = 0;
+    int val;
+    while(deque.pop(val)){
+        popped_sum += val;
+    }
+
+    int failures = 0;
+    if(pushed_sum != stolen_sum + popped_sum){
+        std::cerr<<"pushed sum "<<pushed_sum<<" stolen + popped sum "<<stolen_sum + popped_sum<<"\n";
+        failures++;
+    }
+
+    // a ring that fits DEQUE_LIVE plus every smaller ring we grew out of
+    size_t bound = 0;
+    for(size_t ring=FIRST_BUCKET_SIZE; ; ring*=2){
+        bound += ring * sizeof(std::atomic<int>);
+        if(ring >= (size_t)DEQUE_LIVE)
             break;
+    }
+    size_t bytes = deque.memory_bytes();
+    if(bytes != warm_bytes || bytes > bound){
+        std::cerr<<"memory "<<bytes<<" bytes, "<<warm_bytes<<" after warm up, bound "<<bound<<"\n";
+        failures++;
+    }
+
+    std::cout<<"Ops: "<<stolen<<"\tLive: "<<DEQUE_LIVE<<"\tMemory: "<<bytes<<" bytes\tFailures: "<<failures<<"\n";
+    return failures == 0 ? 0 : 1;
+}
+
+// 64 bit capacity check/benchmark
+// uses char elements so multi-billion element runs actually fit in memory
+// without -fill we only reserve the buckets and probe indices around the 32 bit boundaries
+// with -fill every thread pushes its share of the elements first (timed)
+// push/pop across the 2^32 boundary without filling everything below it first
+// returns the number of failed checks
+int capacity_push_check(){
+    constexpr size_t SEED_SIZE = (1ULL<<32) - 16;
+    constexpr int PUSHES = 32;
+
+    lockfree::Vector<char> vec;
+    vec.init_size_for_benchmarks(SEED_SIZE);
+    vec.set_id(0);
+
+    int failures = 0;
+    for(int i=0; i<PUSHES; i++){
+        vec.push_back((char)(i+1));
+    }
+    if(vec.size() != SEED_SIZE + PUSHES || vec.size_exact() != SEED_SIZE + PUSHES){
+        std::cerr<<"size "<<vec.size()<<" expected "<<SEED_SIZE + PUSHES<<"\n";
+        failures++;
+    }
+    for(int i=0; i<PUSHES; i++){
+        char val = vec.read_at(SEED_SIZE + i);
+        if(val != (char)(i+1)){
+            std::cerr<<"index "<<SEED_SIZE + i<<" read "<<(int)val<<" expected "<<i+1<<"\n";
+            failures++;
+        }
+    }
+    for(int i=PUSHES-1; i>=0; i--){
+        char val = vec.pop_back();
+        if(val != (char)(i+1)){
+            std::cerr<<"pop "<<SEED_SIZE + i<<" returned "<<(int)val<<" expected "<<i+1<<"\n";
+            failures++;
+        }
+    }
+    if(vec.size() != SEED_SIZE){
+        std::cerr<<"size "<<vec.size()<<" expected "<<SEED_SIZE<<" after popping\n";
+        failures++;
+    }
+    return failures;
+}
+
+int run_capacity(size_t elements){
+    lockfree::Vector<char> vec;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    if(CAPACITY_FILL){
+        for(int i=0; i<MAX_THREADS; i++){
+            size_t count = elements / MAX_THREADS + (i == 0 ? elements % MAX_THREADS : 0);
+            threads.push_back(std::thread([&vec,i,count](){
+                vec.set_id(i);
+                for(size_t j=0; j<count; j++){
+                    vec.push_back((char)i);
+                }
+            }));
         }
-        mtx.unlock();
+        for(int i=0;i<threads.size();i++){
+            threads[i].join();
+        }
+    }else{
+        vec.reserve(elements);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end-start);
+    std::cout<<"Threads: "<<MAX_THREADS<<"\tTotal Time: "<<duration.count()<<"ms\n";
+
+    int failures = 0;
+    vec.set_id(0);
+    if(CAPACITY_FILL && vec.size() != elements){
+        std::cerr<<"size "<<vec.size()<<" expected "<<elements<<"\n";
+        failures++;
+    }
+
+    // these all used to truncate/alias with 32 bit indices
+    std::vector<size_t> probes = {
+        0, FIRST_BUCKET_SIZE-1, FIRST_BUCKET_SIZE,
+        (1ULL<<31)-FIRST_BUCKET_SIZE-1, (1ULL<<31)-FIRST_BUCKET_SIZE, (1ULL<<31),
+        (1ULL<<32)-FIRST_BUCKET_SIZE-1, (1ULL<<32)-FIRST_BUCKET_SIZE, (1ULL<<32),
+        elements-1
+    };
+    probes.erase(std::remove_if(probes.begin(), probes.end(), [&](size_t idx){ return idx >= elements; }), probes.end());
+
+    for(int i=0; i<probes.size(); i++){
+        vec.write_at(probes[i], (char)(i+1));
     }
+    for(int i=0; i<probes.size(); i++){
+        char val = vec.read_at(probes[i]);
+        if(val != (char)(i+1)){
+            std::cerr<<"index "<<probes[i]<<" read "<<(int)val<<" expected "<<i+1<<"\n";
+            failures++;
+        }
+    }
+
+    // cheap enough to always run, the fill above only crosses 2^32 if elements does
+    failures += capacity_push_check();
+
+    std::cout<<"Capacity: "<<elements<<"\tProbes: "<<probes.size()<<"\tFailures: "<<failures<<"\n";
+    return failures == 0 ? 0 : 1;
+}
+
+void print_memory_stats(const lockfree::MemoryStats& stats){
+    printf("Object: %zu bytes\n",stats.object_bytes);
+    printf("Buckets: %zu bytes (%zu / %zu slots used)\n",stats.bucket_bytes,stats.used_slots,stats.reserved_slots);
+    printf("Pools: %zu bytes\n",stats.pool_bytes);
+    printf("Descriptors: %zu bytes\n",stats.descriptor_bytes);
+    printf("Wasted: %zu bytes\n",stats.wasted_bytes);
+    printf("Total: %zu bytes\n",stats.total_bytes());
 }
 
 void parse_args(
@@ -154,10 +566,59 @@ void parse_args(
             LF = true;
         if(arg == "-l")
             LF = false;
+        if(arg == "-backend"){
+            assert(i+1 < argc);
+            LF = false;
+            BACKEND = argv[i+1];
+        }
         if(arg == "-s")
             suppress_prints = true;
         if(arg == "-leak")
             LEAK = true;
+        if(arg == "-no-cursor")
+            TAIL_CURSOR = false;
+        if(arg == "-deque")
+            DEQUE = true;
+        if(arg == "-steady"){
+            assert(i+1 < argc);
+            DEQUE_STEADY = std::atol(argv[i+1]);
+        }
+        if(arg == "-live"){
+            assert(i+1 < argc);
+            DEQUE_LIVE = std::atoi(argv[i+1]);
+        }
+        if(arg == "-depth"){
+            assert(i+1 < argc);
+            DEQUE_DEPTH = std::atoi(argv[i+1]);
+        }
+        if(arg == "-record"){
+            assert(i+1 < argc);
+            RECORD_PATH = argv[i+1];
+        }
+        if(arg == "-replay"){
+            assert(i+1 < argc);
+            REPLAY_PATH = argv[i+1];
+        }
+        if(arg == "-asap")
+            REPLAY_ASAP = true;
+        if(arg == "-capacity"){
+            assert(i+1 < argc);
+            CAPACITY = std::stoull(argv[i+1]);
+        }
+        if(arg == "-fill")
+            CAPACITY_FILL = true;
+        if(arg == "-lazy-pools")
+            LAZY_POOLS = true;
+        if(arg == "-mem")
+            PRINT_MEMORY = true;
+        if(arg == "-observers"){
+            assert(i+1 < argc);
+            OBSERVERS = std::atoi(argv[i+1]);
+        }
+        if(arg == "-observe-exact"){
+            OBSERVE_EXACT = true;
+            PUBLISH_SNAPSHOT = false;
+        }
         if(arg == "-threads"){
             assert(i+1 < argc);
             MAX_THREADS = std::atoi(argv[i+1]);
@@ -209,10 +670,86 @@ int main(int argc, char* argv[]){
         pop_prob,
         suppress_prints);
     assert(ABS_MAX_THREADS>=MAX_THREADS); //ensure we don't over compute threads
+
+    // fork-join deque benchmark doesn't use the op sequences
+    if(DEQUE && DEQUE_STEADY > 0){
+        if(!suppress_prints){
+            printf("starting deque steady state check\nOps: %ld\nLive: %d\n\n",DEQUE_STEADY,DEQUE_LIVE);
+        }
+        return run_deque_steady(DEQUE_STEADY);
+    }
+
+    if(DEQUE){
+        if(!suppress_prints){
+            printf("starting fork-join simulation\nThreads: %d\nLock Free: %d\nDepth: %d\nSeed: %d\n\n",MAX_THREADS,LF,DEQUE_DEPTH,SEED);
+        }
+
+        if(LF){
+            run_fork_join<lockfree::Deque<int>>();
+        }else{
+            run_fork_join<MutexDeque>();
+        }
+        return 0;
+    }
+
+    if(CAPACITY > 0){
+        if(!suppress_prints){
+            printf("starting capacity simulation\nThreads: %d\nElements: %zu\nFill: %d\nPools: %d\n\n",MAX_THREADS,CAPACITY,CAPACITY_FILL,MAX_POOLS);
+        }
+        return run_capacity(CAPACITY);
+    }
     
+    // replaying takes the thread count and op counts from the trace instead
+    size_t per_thread_operations = PER_THREAD_OPERATIONS;
+    if(REPLAY_PATH != nullptr){
+        if(!replay_trace.open(REPLAY_PATH)){
+            std::cerr<<"failed to open trace "<<REPLAY_PATH<<"\n";
+            return 1;
+        }
+        // the file is well formed but we can only run as many threads as the vector has room for
+        if(replay_trace.threads() < 1 || replay_trace.threads() > ABS_MAX_THREADS){
+            std::cerr<<"trace "<<REPLAY_PATH<<" has "<<replay_trace.threads()<<" threads, expected 1 to "<<ABS_MAX_THREADS<<"\n";
+            return 1;
+        }
+        MAX_THREADS = replay_trace.threads();
+
+        per_thread_operations = 0;
+        for(int i=0; i<MAX_THREADS; i++){
+            per_thread_operations = std::max(per_thread_operations, (size_t)replay_trace.count(i));
+        }
+    }
+
+    // recording happens inside lockfree::Vector
+    if(RECORD_PATH != nullptr && !LF){
+        std::cerr<<"-record only works with -lf\n";
+        return 1;
+    }
+
     // inti ourselves for bench marks
-    lockfree::Vector<int> lf_vec;
-    lf_vec.init_for_benchmarks(PER_THREAD_OPERATIONS);
+    lockfree::VectorOptions vec_options;
+    vec_options.lazy_pools = LAZY_POOLS;
+    lockfree::Vector<int> lf_vec(vec_options);
+    // same starting elements as run_baseline gives the baselines
+    lf_vec.init_for_benchmarks(per_thread_operations, RANDOM_ACCESS_RANGE+1);
+
+    // benchmark only reserves what pushes can reach, traces can read/write anywhere
+    if(REPLAY_PATH != nullptr){
+        size_t max_idx = 0;
+        for(int i=0; i<MAX_THREADS; i++){
+            const trace::Record* records = replay_trace.records(i);
+            for(uint64_t j=0; j<replay_trace.count(i); j++){
+                if(records[j].op == Op::Read || records[j].op == Op::Write)
+                    max_idx = std::max(max_idx, (size_t)records[j].idx);
+            }
+        }
+        lf_vec.reserve(max_idx+1);
+    }
+
+    trace::Recorder* recorder = nullptr;
+    if(RECORD_PATH != nullptr){
+        recorder = new trace::Recorder(MAX_THREADS, per_thread_operations);
+        lf_vec.set_recorder(recorder);
+    }
 
     std::map<Op, int> percentages = {
         {Op::Read, read_prob},
@@ -224,33 +761,58 @@ int main(int argc, char* argv[]){
     assert(read_prob + write_prob + push_prob + pop_prob == 100);
 
     if(!suppress_prints){
-        printf("starting simulation\nThreads: %d\nLock Free: %d\nLeak: %d\nOperations: %d\nPools: %d\nSeed: %d\n\n",MAX_THREADS,LF,LEAK,PER_THREAD_OPERATIONS,MAX_POOLS,SEED);
-        std::cout<<"Operation Probabilities\n";
-        for(const auto& pair: percentages){
-            std::cout<<op_to_string(pair.first)<<": "<<pair.second<<"%\n";
+        printf("starting simulation\nThreads: %d\nLock Free: %d\nBackend: %s\nLeak: %d\nTail Cursor: %d\nObservers: %d%s\nOperations: %zu\nPools: %d\nSeed: %d\n\n",MAX_THREADS,LF,LF ? "lockfree" : BACKEND.c_str(),LEAK,TAIL_CURSOR,OBSERVERS,OBSERVE_EXACT ? " (exact)" : "",per_thread_operations,MAX_POOLS,SEED);
+        if(REPLAY_PATH != nullptr){
+            printf("Replaying: %s (%s)\n",REPLAY_PATH,REPLAY_ASAP ? "asap" : "recorded timing");
+        }else{
+            std::cout<<"Operation Probabilities\n";
+            for(const auto& pair: percentages){
+                std::cout<<op_to_string(pair.first)<<": "<<pair.second<<"%\n";
+            }
+        }
+        if(RECORD_PATH != nullptr){
+            printf("Recording: %s\n",RECORD_PATH);
         }
     }
 
     // generate sequences for each thread
-    for(int i=0; i<MAX_THREADS;i++){
-        sequences.push_back(generate_operation_sequence(PER_THREAD_OPERATIONS, percentages, SEED+i));
+    if(REPLAY_PATH == nullptr){
+        for(int i=0; i<MAX_THREADS;i++){
+            sequences.push_back(generate_operation_sequence(PER_THREAD_OPERATIONS, percentages, SEED+i));
+        }
     }
 
-    auto start = std::chrono::high_resolution_clock::now();
-    for(int i=0;i<MAX_THREADS; i++){
-        if(LF){
-            threads.push_back(std::thread(lf_work,i,std::ref(lf_vec)));
-        }else{
-            threads.push_back(std::thread(mtx_work,i));
-        }
+    long duration;
+    if(LF){
+        duration = run_lf(lf_vec, recorder);
+    }else if(BACKEND == "mtx"){
+        duration = run_baseline<baseline::LockedVector<int, std::mutex>>();
+    }else if(BACKEND == "spin"){
+        duration = run_baseline<baseline::LockedVector<int, baseline::SpinLock>>();
+    }else if(BACKEND == "shared"){
+        duration = run_baseline<baseline::SharedMutexVector<int>>();
+    }else if(BACKEND == "striped"){
+        duration = run_baseline<baseline::StripedVector<int>>();
+    }else if(BACKEND == "segmented"){
+        duration = run_baseline<baseline::SegmentedVector<int>>();
+    }else{
+        std::cerr<<"unknown backend "<<BACKEND<<"\n";
+        return 1;
     }
+    std::cout<<"Threads: "<<MAX_THREADS<<"\tTotal Time: "<<duration<<"ms\n";
 
-    for(int i=0;i<threads.size();i++){
-        threads[i].join();
+    if(PRINT_MEMORY && LF){
+        print_memory_stats(lf_vec.memory_stats());
+    }
+
+    if(recorder != nullptr){
+        lf_vec.set_recorder(nullptr);
+        if(!recorder->save(RECORD_PATH)){
+            std::cerr<<"failed to save trace "<<RECORD_PATH<<"\n";
+            return 1;
+        }
+        delete recorder;
     }
-    auto end = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end-start);
-    std::cout<<"Threads: "<<MAX_THREADS<<"\tTotal Time: "<<duration.count()<<"ms\n";
  
     return 0;
 } 
\ No newline at end of file
@@ -31,7 +31,7 @@ private:
     // std::stack<int> free_spots;
 
 public: 
-    Pool(){};
+    Pool() : size(0), mem(nullptr){};
     Pool(int pool_id, int size){
         this->size = size;
         this->mem = new Node<T>[size];
@@ -49,6 +49,16 @@ public:
         //     std::cout<<"block: "<<i<<" "<<this->mem[i].ref<<" | ";
         // }
         // printf("\n");
+        delete[] this->mem;
+    }
+
+    // we own mem, Vector only ever hands out pointers to pools
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    // memory held by this pool (the pool itself and its nodes)
+    size_t bytes() const {
+        return sizeof(Pool<T>) + size * sizeof(Node<T>);
     }
 
     // grab a free node (unreferenced) from the memory pool
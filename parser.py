@@ -52,7 +52,7 @@ def parse_tests(file_path):
 def plot_tests_separately_and_mega(tests, filename_base):
     os.makedirs(f"{FIGURES_DIR}/{filename_base}",exist_ok=True)
 
-    categories = ['STL-MTX', 'LF-P-1', 'LF-P-T', 'LF-LEAKS']
+    categories = ['STL-MTX', 'STL-SHARED', 'TTAS-SPIN', 'STRIPED', 'SEGMENTED', 'LF-P-1', 'LF-P-T', 'LF-LEAKS', 'LF-NO-CURSOR', 'DEQUE-MTX', 'DEQUE-LF', 'LF-CAPACITY', 'LF-OBS-SNAPSHOT', 'LF-OBS-EXACT']
 
     # Create mega page figure with one subplot per test stacked vertically
     mega_fig_height = len(tests) * 4  # 4 inches height per subplot
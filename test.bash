@@ -24,6 +24,42 @@ function test() {
         ./vec_sim.out -s -l -threads "$threads" -pools 1 -seed "$5" -push "$1" -pop "$2" -write "$3" -read "$4"
     done
     echo "END_PART"
+
+    echo "locked tests | seed: $5 | backend: shared | ${1}+ / ${2}- / ${3}w / ${4}r"
+    echo "START_PART"
+
+    echo "STL-SHARED"
+    for threads in 1 2 4 8 16 32; do
+        ./vec_sim.out -s -backend shared -threads "$threads" -seed "$5" -push "$1" -pop "$2" -write "$3" -read "$4"
+    done
+    echo "END_PART"
+
+    echo "locked tests | seed: $5 | backend: spin | ${1}+ / ${2}- / ${3}w / ${4}r"
+    echo "START_PART"
+
+    echo "TTAS-SPIN"
+    for threads in 1 2 4 8 16 32; do
+        ./vec_sim.out -s -backend spin -threads "$threads" -seed "$5" -push "$1" -pop "$2" -write "$3" -read "$4"
+    done
+    echo "END_PART"
+
+    echo "locked tests | seed: $5 | backend: striped | ${1}+ / ${2}- / ${3}w / ${4}r"
+    echo "START_PART"
+
+    echo "STRIPED"
+    for threads in 1 2 4 8 16 32; do
+        ./vec_sim.out -s -backend striped -threads "$threads" -seed "$5" -push "$1" -pop "$2" -write "$3" -read "$4"
+    done
+    echo "END_PART"
+
+    echo "locked tests | seed: $5 | backend: segmented | ${1}+ / ${2}- / ${3}w / ${4}r"
+    echo "START_PART"
+
+    echo "SEGMENTED"
+    for threads in 1 2 4 8 16 32; do
+        ./vec_sim.out -s -backend segmented -threads "$threads" -seed "$5" -push "$1" -pop "$2" -write "$3" -read "$4"
+    done
+    echo "END_PART"
     
     echo "lock_free tests | seed: $5 | pools: 1 | ${1}+ / ${2}- / ${3}w / ${4}r"
     echo "START_PART"
@@ -55,6 +91,118 @@ function test() {
     echo "END_TEST"
 }
 
+# isolates the tail cursor in push_back/pop_back
+# same as the LF-P-T part just with the cursor turned off
+function cursor_test() {
+    echo "START_TEST"
+
+    echo "lock_free tests | seed: $5 | pools: T | ${1}+ / ${2}- / ${3}w / ${4}r"
+    echo "START_PART"
+
+    echo "LF-P-T"
+    for threads in 1 2 4 8 16 32; do
+        ./vec_sim.out -s -lf -threads "$threads" -pools "$threads" -seed "$5" -push "$1" -pop "$2" -write "$3" -read "$4"
+    done
+    echo "END_PART"
+
+    echo "lock_free tests | seed: $5 | pools: T (no cursor) | ${1}+ / ${2}- / ${3}w / ${4}r"
+    echo "START_PART"
+
+    echo "LF-NO-CURSOR"
+    for threads in 1 2 4 8 16 32; do
+        ./vec_sim.out -s -lf -no-cursor -threads "$threads" -pools "$threads" -seed "$5" -push "$1" -pop "$2" -write "$3" -read "$4"
+    done
+    echo "END_PART"
+
+    echo "END_TEST"
+}
+
+# fork-join over the work stealing deques
+# depth = $1
+# seed = $2
+function fork_join_test() {
+    # the deque's memory has to stay flat while lots of elements go through it
+    ./vec_sim.out -s -deque -steady 1000000 -live 1
+    ./vec_sim.out -s -deque -steady 1000000 -live 1000
+
+    echo "START_TEST"
+
+    echo "locked tests | seed: $2 | depth: $1 | fork-join"
+    echo "START_PART"
+
+    echo "DEQUE-MTX"
+    for threads in 1 2 4 8 16 32; do
+        ./vec_sim.out -s -deque -l -threads "$threads" -depth "$1" -seed "$2"
+    done
+    echo "END_PART"
+
+    echo "lock_free tests | seed: $2 | depth: $1 | fork-join"
+    echo "START_PART"
+
+    echo "DEQUE-LF"
+    for threads in 1 2 4 8 16 32; do
+        ./vec_sim.out -s -deque -lf -threads "$threads" -depth "$1" -seed "$2"
+    done
+    echo "END_PART"
+
+    echo "END_TEST"
+}
+
+# 64 bit capacity, the sparse check always runs
+# it reserves $1 char elements and probes around the 32 bit boundaries, then pushes/pops across 2^32
+# from a seeded size so the push path is covered without filling everything below it
+#
+# the full fill pushes all $1 elements at every thread count, it needs about 2x $1 bytes of memory
+# and takes a long time past 4 billion elements so it only runs with CAPACITY_FILL=1
+function capacity_test() {
+    echo "START_TEST"
+
+    ./vec_sim.out -s -capacity "$1"
+
+    if [ "$CAPACITY_FILL" != "1" ]; then
+        echo "END_TEST"
+        return
+    fi
+
+    echo "lock_free tests | elements: $1 | pools: T | fill"
+    echo "START_PART"
+
+    echo "LF-CAPACITY"
+    for threads in 1 2 4 8 16 32; do
+        ./vec_sim.out -s -capacity "$1" -fill -threads "$threads" -pools "$threads"
+    done
+    echo "END_PART"
+
+    echo "END_TEST"
+}
+
+# producers with $1 observer threads polling size()/empty()/back() the whole time
+# snapshot observers only load, exact ones take a pool reference on the descriptor like size() used to
+# (and the exact runs don't publish the snapshot at all, so they are the old producers)
+function observer_test() {
+    echo "START_TEST"
+
+    echo "lock_free tests | seed: $6 | observers: $1 | ${2}+ / ${3}- / ${4}w / ${5}r"
+    echo "START_PART"
+
+    echo "LF-OBS-SNAPSHOT"
+    for threads in 1 2 4 8 16 32; do
+        ./vec_sim.out -s -lf -observers "$1" -threads "$threads" -pools "$threads" -seed "$6" -push "$2" -pop "$3" -write "$4" -read "$5"
+    done
+    echo "END_PART"
+
+    echo "lock_free tests | seed: $6 | observers: $1 (exact) | ${2}+ / ${3}- / ${4}w / ${5}r"
+    echo "START_PART"
+
+    echo "LF-OBS-EXACT"
+    for threads in 1 2 4 8 16 32; do
+        ./vec_sim.out -s -lf -observers "$1" -observe-exact -threads "$threads" -pools "$threads" -seed "$6" -push "$2" -pop "$3" -write "$4" -read "$5"
+    done
+    echo "END_PART"
+
+    echo "END_TEST"
+}
+
 #(pop,push,write,read)
 test 15 5 10 70 42
 test 15 0 15 70 42
@@ -65,3 +213,15 @@ test 15 0 15 70 42
 test 0 0 0 100 42
 test 50 0 5 45
 
+cursor_test 50 50 0 0 42
+cursor_test 100 0 0 0 42
+
+fork_join_test 20 42
+
+capacity_test 5000000000
+
+# no observers, just what publishing the snapshot costs the producers against the old size()
+observer_test 0 50 50 0 0 42
+observer_test 1 50 50 0 0 42
+observer_test 4 50 50 0 0 42
+observer_test 16 50 50 0 0 42
@@ -0,0 +1,207 @@
+#ifndef TRACE_H
+#define TRACE_H
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// operation traces so we can replay real traffic through the benchmark
+//
+// file layout (native endian, everything 8 byte aligned):
+//   Header
+//   uint64_t counts[threads]       number of records for each thread
+//   Record   records[sum(counts)]  thread 0's records, then thread 1's, ...
+//
+// each thread's records are in the order that thread issued them and carry the time since
+// that thread's previous op (or since recording started for its first op), so a replay can
+// reproduce the original timing per thread without any cross thread bookkeeping
+namespace trace {
+enum class Op : uint8_t {
+    Read,
+    Write,
+    Push,
+    Pop
+};
+
+constexpr char MAGIC[4] = {'L','F','V','T'};
+constexpr uint32_t VERSION = 1;
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t threads;
+    uint32_t reserved;
+};
+
+struct Record {
+    uint64_t idx;      // read/write index, slot pushed into or popped from
+    uint32_t delta_ns; // time since this thread's previous record (saturates at ~4.2s)
+    Op op;
+    uint8_t pad[3];
+};
+static_assert(sizeof(Header) == 16, "trace header layout changed");
+static_assert(sizeof(Record) == 16, "trace record layout changed");
+
+// collects records at runtime
+// every thread only ever appends to its own log so recording needs no synchronization
+class Recorder {
+private:
+    // padded so threads don't false share their log headers
+    struct alignas(64) ThreadLog {
+        std::vector<Record> records;
+        std::chrono::steady_clock::time_point last;
+    };
+
+    int threads;
+    ThreadLog* logs;
+
+public:
+    Recorder(int threads, size_t reserve_per_thread = 0) : threads(threads), logs(new ThreadLog[threads]){
+        auto start = std::chrono::steady_clock::now();
+        for(int i=0; i<threads; i++){
+            logs[i].records.reserve(reserve_per_thread);
+            logs[i].last = start;
+        }
+    }
+
+    ~Recorder(){
+        delete[] logs;
+    }
+
+    // sets the time every thread's first delta is measured from
+    // call it with the run's start time before any thread records, otherwise the
+    // first delta includes everything since the recorder was constructed
+    void start(std::chrono::steady_clock::time_point origin){
+        for(int i=0; i<threads; i++){
+            logs[i].last = origin;
+        }
+    }
+
+    void record(int thread, Op op, uint64_t idx){
+        assert(thread >= 0 && thread < threads);
+        ThreadLog& log = logs[thread];
+
+        auto now = std::chrono::steady_clock::now();
+        uint64_t delta = std::chrono::duration_cast<std::chrono::nanoseconds>(now - log.last).count();
+        log.last = now;
+
+        Record rec;
+        rec.idx = idx;
+        rec.delta_ns = delta > UINT32_MAX ? UINT32_MAX : (uint32_t)delta;
+        rec.op = op;
+        memset(rec.pad, 0, sizeof(rec.pad));
+        log.records.push_back(rec);
+    }
+
+    // only call once every recording thread is done
+    bool save(const char* path){
+        FILE* file = fopen(path, "wb");
+        if(file == nullptr){
+            return false;
+        }
+
+        Header header;
+        memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.threads = threads;
+        header.reserved = 0;
+
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+        for(int i=0; ok && i<threads; i++){
+            uint64_t count = logs[i].records.size();
+            ok = fwrite(&count, sizeof(count), 1, file) == 1;
+        }
+        for(int i=0; ok && i<threads; i++){
+            size_t count = logs[i].records.size();
+            ok = fwrite(logs[i].records.data(), sizeof(Record), count, file) == count;
+        }
+
+        return fclose(file) == 0 && ok;
+    }
+};
+
+// read only view of a trace file, memory mapped so replays stream straight from the page cache
+class Trace {
+private:
+    void* data = MAP_FAILED;
+    size_t length = 0;
+    const Header* header = nullptr;
+    const uint64_t* counts = nullptr;
+    std::vector<const Record*> starts; // first record of each thread
+
+public:
+    Trace(){};
+    Trace(const Trace&) = delete;
+    Trace& operator=(const Trace&) = delete;
+
+    ~Trace(){
+        if(data != MAP_FAILED){
+            munmap(data, length);
+        }
+    }
+
+    // returns false if the file can't be mapped or isn't a valid trace
+    bool open(const char* path){
+        int fd = ::open(path, O_RDONLY);
+        if(fd < 0){
+            return false;
+        }
+
+        struct stat st;
+        if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Header)){
+            close(fd);
+            return false;
+        }
+
+        length = st.st_size;
+        data = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd); // the mapping keeps the file alive
+        if(data == MAP_FAILED){
+            return false;
+        }
+        madvise(data, length, MADV_SEQUENTIAL);
+
+        header = (const Header*)data;
+        if(memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION){
+            return false;
+        }
+
+        // make sure the counts and records actually fit in the file
+        size_t offset = sizeof(Header) + header->threads * sizeof(uint64_t);
+        if(offset > length){
+            return false;
+        }
+        counts = (const uint64_t*)((const char*)data + sizeof(Header));
+
+        for(uint32_t i=0; i<header->threads; i++){
+            if(counts[i] > (length - offset) / sizeof(Record)){
+                return false;
+            }
+            starts.push_back((const Record*)((const char*)data + offset));
+            offset += counts[i] * sizeof(Record);
+        }
+        return true;
+    }
+
+    int threads() const {
+        return header->threads;
+    }
+
+    uint64_t count(int thread) const {
+        return counts[thread];
+    }
+
+    const Record* records(int thread) const {
+        return starts[thread];
+    }
+};
+};
+
+#endif